@@ -0,0 +1,46 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+/*
+ * Execution model.
+ *
+ * Real-time work (weld sequencing, and the charge loop when it lands) lives on
+ * RT_CORE: a pinned high-priority task plus a level-3 timer ISR whose handler
+ * and the driver calls it makes are IRAM-resident, so flash writes and
+ * cache misses do not stall it. Everything the user sees lives on UI_CORE at
+ * low priority: ui_task, the encoder GPIO ISR (level 1), the console, the
+ * telemetry drain task and the test harnesses.
+ *
+ * On single-core chips (ESP32-C3/C6) both map to core 0 and nothing isolates
+ * the weld ISR from the UI. A level-3 interrupt is masked by every
+ * portENTER_CRITICAL, and the UI path takes them constantly: spi_master, the
+ * gpio/ledc/pm drivers, the FreeRTOS kernel and wake_mux on every encoder
+ * edge. Each weld edge can therefore be late by the longest critical section
+ * on core 0 at that moment. ESP-IDF documents no bound for that and none has
+ * been measured here; the jitter harness (RMT capture on the C3) is the way to
+ * find it on a given build.
+ *
+ * Paths that never block: weld_alarm_cb, encoder_isr_handler, weld_fire(),
+ * telemetry_put() and the trace points. Paths that may block: ui_task (SPI
+ * polling transmit and its 30 ms period), weld_task (waiting for a request or
+ * for the sequence to finish), the console REPL (UART reads), telemetry_task
+ * (transport writes) and weld_init() (waits for weld_task to come up). Nothing
+ * on RT_CORE may wait on SPI, the console or a lock shared with ui_task.
+ */
+
+#if CONFIG_FREERTOS_UNICORE
+#define RT_CORE 0
+#define UI_CORE 0
+#else
+#define RT_CORE 1
+#define UI_CORE 0
+#endif
+
+#define PRIO_WELD (configMAX_PRIORITIES - 2)
+#define PRIO_CHARGE (configMAX_PRIORITIES - 3)
+#define PRIO_UI 2
+#define PRIO_TELEMETRY 1
+
+#define WELD_INTR_LEVEL 3
@@ -0,0 +1,101 @@
+#include "jitter_stats.h"
+
+#include <stdlib.h>
+
+void jitter_stats_init(jitter_stats_t *st, uint32_t *err_buf, size_t capacity,
+                       uint32_t tick_hz, const uint32_t nominal_us[3], uint32_t tolerance_ns,
+                       uint32_t start_budget_ns)
+{
+    st->tick_hz = tick_hz;
+    st->tolerance_ns = tolerance_ns;
+    st->start_budget_ns = start_budget_ns;
+    if (nominal_us[1] == 0 || nominal_us[2] == 0) {
+        st->nominal_ns[0] = (nominal_us[0] + nominal_us[2]) * 1000u;
+        st->intervals = 1;
+    } else {
+        for (int i = 0; i < 3; i++) {
+            st->nominal_ns[i] = nominal_us[i] * 1000u;
+        }
+        st->intervals = 3;
+    }
+
+    st->err_ns = err_buf;
+    st->capacity = capacity;
+    st->n = 0;
+    st->sequences = 0;
+    st->misses = 0;
+    st->lost = 0;
+    st->late_starts = 0;
+    st->start_max_ns = 0;
+}
+
+void jitter_stats_add(jitter_stats_t *st, uint32_t start_ns, const jitter_edge_t *edges, size_t count)
+{
+    st->sequences++;
+
+    bool missed = false;
+    if (start_ns > st->start_max_ns) {
+        st->start_max_ns = start_ns;
+    }
+    if (start_ns > st->start_budget_ns) {
+        st->late_starts++;
+        missed = true;
+    }
+
+    if (count != (size_t)st->intervals + 1) {
+        st->lost++;
+        st->misses++;
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (edges[i].rising != ((i & 1) == 0)) {
+            st->lost++;
+            st->misses++;
+            return;
+        }
+    }
+
+    for (int i = 0; i < st->intervals; i++) {
+        uint32_t ticks = edges[i + 1].ticks - edges[i].ticks;
+        uint64_t measured = (uint64_t)ticks * 1000000000u / st->tick_hz;
+        uint64_t nominal = st->nominal_ns[i];
+        uint64_t err = measured > nominal ? measured - nominal : nominal - measured;
+        if (err > UINT32_MAX) {
+            err = UINT32_MAX;
+        }
+
+        if (st->n < st->capacity) {
+            st->err_ns[st->n++] = (uint32_t)err;
+        }
+        if (err > st->tolerance_ns) {
+            missed = true;
+        }
+    }
+    if (missed) {
+        st->misses++;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t jitter_stats_percentile(jitter_stats_t *st, int permille)
+{
+    if (st->n == 0) {
+        return 0;
+    }
+
+    qsort(st->err_ns, st->n, sizeof(st->err_ns[0]), cmp_u32);
+    size_t idx = (st->n * (size_t)permille + 999) / 1000;
+    if (idx > 0) {
+        idx--;
+    }
+    if (idx >= st->n) {
+        idx = st->n - 1;
+    }
+    return st->err_ns[idx];
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Edge analysis for the weld jitter harness. Plain C with no ESP-IDF
+ * dependencies, so the same code can be fed synthetic edges on a host; see
+ * test/host/CMakeLists.txt for the command that runs those tests.
+ */
+
+typedef struct {
+    uint32_t ticks;
+    bool rising;
+} jitter_edge_t;
+
+typedef struct {
+    uint32_t tick_hz;
+    uint32_t nominal_ns[3];
+    int intervals;
+    uint32_t tolerance_ns;
+    uint32_t start_budget_ns;
+
+    uint32_t *err_ns;
+    size_t capacity;
+    size_t n;
+
+    uint32_t sequences;
+    uint32_t misses;
+    uint32_t lost;
+    uint32_t late_starts;
+    uint32_t start_max_ns;
+} jitter_stats_t;
+
+/*
+ * nominal_us holds PULSE1, INTERVAL, PULSE2. A zero INTERVAL or PULSE2 means
+ * the sequence is a single pulse of PULSE1 + PULSE2, matching weld_fire().
+ */
+void jitter_stats_init(jitter_stats_t *st, uint32_t *err_buf, size_t capacity,
+                       uint32_t tick_hz, const uint32_t nominal_us[3], uint32_t tolerance_ns,
+                       uint32_t start_budget_ns);
+
+/*
+ * Adds one sequence. start_ns is the time from weld_fire() to the first edge
+ * and is judged against start_budget_ns, so a sequence that starts late is a
+ * miss even when its edges are evenly spaced. A wrong edge count or polarity
+ * counts as lost and missed.
+ */
+void jitter_stats_add(jitter_stats_t *st, uint32_t start_ns, const jitter_edge_t *edges, size_t count);
+
+/* Sorts the collected errors in place; permille 500 is the median. */
+uint32_t jitter_stats_percentile(jitter_stats_t *st, int permille);
@@ -7,8 +7,23 @@
 #include "driver/spi_master.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "hal/gpio_ll.h"
+
+#include "exec_model.h"
+#include "perf_trace.h"
+#include "telemetry.h"
+#include "weld.h"
+#include "weld_jitter.h"
+
+/* encoder_isr_handler runs under ESP_INTR_FLAG_IRAM and calls gpio_get_level(). */
+#if !CONFIG_GPIO_CTRL_FUNC_IN_IRAM
+#error "CONFIG_GPIO_CTRL_FUNC_IN_IRAM is required (see sdkconfig.defaults)"
+#endif
 
 #define LCD_HOST SPI2_HOST
 
@@ -23,6 +38,8 @@
 #define ENC_PIN_B 8
 #define ENC_PIN_SW 6
 
+#define PIN_WELD_OUT 9
+
 #define LCD_WIDTH 160
 #define LCD_HEIGHT 128
 
@@ -36,6 +53,14 @@
 #define COLOR_ORANGE 0xFD20
 #define COLOR_BLUE 0x03BF
 
+#define BACKLIGHT_DUTY 205
+#define BACKLIGHT_DIM_DUTY 24
+#define BACKLIGHT_FADE_MS 500
+#define BACKLIGHT_WAKE_FADE_MS 150
+
+#define IDLE_DIM_MS (30 * 1000)
+#define IDLE_SLEEP_MS (60 * 1000)
+
 #define LCD_TX_CHUNK_BYTES 32
 #define ST7735_MADCTL 0x36
 
@@ -47,9 +72,20 @@ static spi_device_handle_t lcd_spi;
 static volatile uint8_t encoder_state = 0;
 static volatile int8_t encoder_delta = 0;
 
+static TaskHandle_t ui_task_handle;
+static portMUX_TYPE wake_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool wake_armed = false;
+static volatile int64_t wake_time_us = 0;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t ui_pm_lock;
+#endif
+
 typedef enum {
     SCREEN_MAIN = 0,
     SCREEN_SETTINGS,
+#if CONFIG_SPOT_PERF_TRACE
+    SCREEN_DIAG,
+#endif
 } screen_id_t;
 
 typedef enum {
@@ -68,6 +104,9 @@ typedef enum {
     SET_MAX_CHARGE_POWER,
     SET_BUZZER,
     SET_SAVE_MODE,
+#if CONFIG_SPOT_PERF_TRACE
+    SET_DIAG,
+#endif
     SET_EXIT,
     SET_COUNT,
 } setting_item_t;
@@ -165,6 +204,7 @@ static esp_err_t st7735_send_cmd(uint8_t cmd)
     spi_transaction_t t = {0};
     t.length = 8;
     t.tx_buffer = &cmd;
+    PERF_TRACE_SPI(1);
     gpio_set_level(PIN_NUM_DC, 0);
     return spi_device_polling_transmit(lcd_spi, &t);
 }
@@ -178,12 +218,14 @@ static esp_err_t st7735_send_data(const uint8_t *data, int len)
     spi_transaction_t t = {0};
     t.length = len * 8;
     t.tx_buffer = data;
+    PERF_TRACE_SPI(len);
     gpio_set_level(PIN_NUM_DC, 1);
     return spi_device_polling_transmit(lcd_spi, &t);
 }
 
 static void st7735_set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
 {
+    PERF_TRACE_BEGIN(PERF_SET_ADDR_WINDOW);
     uint8_t data[4];
 
     st7735_send_cmd(0x2A);
@@ -201,6 +243,7 @@ static void st7735_set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16
     st7735_send_data(data, 4);
 
     st7735_send_cmd(0x2C);
+    PERF_TRACE_END(PERF_SET_ADDR_WINDOW);
 }
 
 static void st7735_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
@@ -209,6 +252,7 @@ static void st7735_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uin
         return;
     }
 
+    PERF_TRACE_BEGIN(PERF_FILL_RECT);
     uint16_t x1 = x + w - 1;
     uint16_t y1 = y + h - 1;
     if (x1 >= LCD_WIDTH) {
@@ -231,6 +275,7 @@ static void st7735_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uin
         st7735_send_data((const uint8_t *)chunk, tx_len);
         total_bytes -= tx_len;
     }
+    PERF_TRACE_END(PERF_FILL_RECT);
 }
 
 static void st7735_draw_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
@@ -238,15 +283,19 @@ static void st7735_draw_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uin
     if (w < 2 || h < 2) {
         return;
     }
+    PERF_TRACE_BEGIN(PERF_DRAW_RECT);
     st7735_fill_rect(x, y, w, 1, color);
     st7735_fill_rect(x, y + h - 1, w, 1, color);
     st7735_fill_rect(x, y, 1, h, color);
     st7735_fill_rect(x + w - 1, y, 1, h, color);
+    PERF_TRACE_END(PERF_DRAW_RECT);
 }
 
 static void st7735_fill_screen(uint16_t color)
 {
+    PERF_TRACE_BEGIN(PERF_FILL_SCREEN);
     st7735_fill_rect(0, 0, LCD_WIDTH, LCD_HEIGHT, color);
+    PERF_TRACE_END(PERF_FILL_SCREEN);
 }
 
 static void st7735_draw_char(uint16_t x, uint16_t y, char c, uint16_t color)
@@ -255,6 +304,7 @@ static void st7735_draw_char(uint16_t x, uint16_t y, char c, uint16_t color)
         return;
     }
 
+    PERF_TRACE_BEGIN(PERF_DRAW_CHAR);
     uint8_t glyph_index = (uint8_t)(c - 32);
     uint16_t x1 = x + 5;
     uint16_t y1 = y + 7;
@@ -284,10 +334,12 @@ static void st7735_draw_char(uint16_t x, uint16_t y, char c, uint16_t color)
         }
         st7735_send_data((const uint8_t *)row_pixel, width * 2);
     }
+    PERF_TRACE_END(PERF_DRAW_CHAR);
 }
 
 static void st7735_draw_string(uint16_t x, uint16_t y, const char *str, uint16_t color)
 {
+    PERF_TRACE_BEGIN(PERF_DRAW_STRING);
     while (*str != '\0') {
         if (x + 6 > LCD_WIDTH) {
             break;
@@ -296,6 +348,7 @@ static void st7735_draw_string(uint16_t x, uint16_t y, const char *str, uint16_t
         x += 6;
         str++;
     }
+    PERF_TRACE_END(PERF_DRAW_STRING);
 }
 
 static void st7735_init(void)
@@ -325,7 +378,8 @@ static void backlight_init(void)
         .duty_resolution = LEDC_TIMER_8_BIT,
         .timer_num = LEDC_TIMER_0,
         .freq_hz = 5000,
-        .clk_cfg = LEDC_AUTO_CLK,
+        /* XTAL keeps the PWM and fade timing fixed while DFS moves the APB clock. */
+        .clk_cfg = LEDC_USE_XTAL_CLK,
     };
     ESP_ERROR_CHECK(ledc_timer_config(&timer_cfg));
 
@@ -335,10 +389,20 @@ static void backlight_init(void)
         .channel = LEDC_CHANNEL_0,
         .intr_type = LEDC_INTR_DISABLE,
         .timer_sel = LEDC_TIMER_0,
-        .duty = 205,
+        .duty = BACKLIGHT_DUTY,
         .hpoint = 0,
     };
     ESP_ERROR_CHECK(ledc_channel_config(&channel_cfg));
+    ESP_ERROR_CHECK(ledc_fade_func_install(0));
+}
+
+/*
+ * The LEDC fade engine ramps the duty in hardware. Starting a fade blocks until
+ * a running one ends, so the wake fade stops the dim fade first.
+ */
+static void backlight_fade(uint32_t duty, uint32_t ms, ledc_fade_mode_t wait)
+{
+    ESP_ERROR_CHECK(ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty, ms, wait));
 }
 
 static void display_init(void)
@@ -380,9 +444,60 @@ static void display_init(void)
     ESP_LOGI(TAG, "Display initialized");
 }
 
+/*
+ * While asleep the encoder and switch pins wake the chip on the level opposite
+ * to the one they rested at. Level interrupts would refire until the pin moves
+ * back, so the first one restores the edge setup with register writes (the
+ * gpio driver calls are not IRAM-safe) and wakes ui_task. The encoder ISR then
+ * decodes that same transition, so the first detent after wake is not lost.
+ */
+static void IRAM_ATTR wake_disarm_from_isr(void)
+{
+    portENTER_CRITICAL_ISR(&wake_mux);
+    if (wake_armed) {
+        gpio_dev_t *hw = GPIO_LL_GET_HW(GPIO_PORT_0);
+        gpio_ll_wakeup_disable(hw, ENC_PIN_A);
+        gpio_ll_wakeup_disable(hw, ENC_PIN_B);
+        gpio_ll_wakeup_disable(hw, ENC_PIN_SW);
+        gpio_ll_set_intr_type(hw, ENC_PIN_A, GPIO_INTR_ANYEDGE);
+        gpio_ll_set_intr_type(hw, ENC_PIN_B, GPIO_INTR_ANYEDGE);
+        gpio_ll_set_intr_type(hw, ENC_PIN_SW, GPIO_INTR_DISABLE);
+        wake_armed = false;
+        wake_time_us = esp_timer_get_time();
+
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(ui_task_handle, &woken);
+        portEXIT_CRITICAL_ISR(&wake_mux);
+        portYIELD_FROM_ISR(woken);
+        return;
+    }
+    portEXIT_CRITICAL_ISR(&wake_mux);
+}
+
+static void wake_arm(void)
+{
+    static const int pins[] = {ENC_PIN_A, ENC_PIN_B, ENC_PIN_SW};
+
+    portENTER_CRITICAL(&wake_mux);
+    for (int i = 0; i < (int)(sizeof(pins) / sizeof(pins[0])); i++) {
+        gpio_int_type_t level = gpio_get_level(pins[i]) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+        gpio_wakeup_enable(pins[i], level);
+    }
+    wake_armed = true;
+    portEXIT_CRITICAL(&wake_mux);
+}
+
+static void IRAM_ATTR switch_isr_handler(void *arg)
+{
+    (void)arg;
+    wake_disarm_from_isr();
+}
+
 static void IRAM_ATTR encoder_isr_handler(void *arg)
 {
     (void)arg;
+    PERF_TRACE_BEGIN(PERF_ENCODER_ISR);
+    wake_disarm_from_isr();
     static const int8_t table[16] = {
         0, -1, 1, 0,
         1, 0, 0, -1,
@@ -398,6 +513,7 @@ static void IRAM_ATTR encoder_isr_handler(void *arg)
     encoder_delta += step;
     counter += step;
     encoder_state = state;
+    PERF_TRACE_END(PERF_ENCODER_ISR);
 }
 
 static void encoder_init(void)
@@ -417,9 +533,12 @@ static void encoder_init(void)
     uint8_t b = (uint8_t)gpio_get_level(ENC_PIN_B);
     encoder_state = (a << 1) | b;
 
-    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    /* Installed from app_main, so the encoder interrupt lands on UI_CORE. */
+    ESP_ERROR_CHECK(gpio_install_isr_service(ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_LEVEL1));
     ESP_ERROR_CHECK(gpio_isr_handler_add(ENC_PIN_A, encoder_isr_handler, NULL));
     ESP_ERROR_CHECK(gpio_isr_handler_add(ENC_PIN_B, encoder_isr_handler, NULL));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(ENC_PIN_SW, switch_isr_handler, NULL));
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
     ESP_LOGI(TAG, "Encoder initialized");
 }
 
@@ -432,6 +551,17 @@ static void draw_box(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t fi
     }
 }
 
+static int clamp_i(int v, int lo, int hi)
+{
+    if (v < lo) {
+        return lo;
+    }
+    if (v > hi) {
+        return hi;
+    }
+    return v;
+}
+
 static void format_1decimal(char *out, size_t len, int tenths)
 {
     int whole = tenths / 10;
@@ -452,13 +582,16 @@ static void st7735_draw_pixel(uint16_t x, uint16_t y, uint16_t color)
         return;
     }
 
+    PERF_TRACE_BEGIN(PERF_DRAW_PIXEL);
     uint16_t px = (uint16_t)((color << 8) | (color >> 8));
     st7735_set_addr_window(x, y, x, y);
     st7735_send_data((const uint8_t *)&px, 2);
+    PERF_TRACE_END(PERF_DRAW_PIXEL);
 }
 
 static void st7735_draw_line(int x0, int y0, int x1, int y1, uint16_t color)
 {
+    PERF_TRACE_BEGIN(PERF_DRAW_LINE);
     int dx = (x1 > x0) ? (x1 - x0) : (x0 - x1);
     int sx = (x0 < x1) ? 1 : -1;
     int dy = -((y1 > y0) ? (y1 - y0) : (y0 - y1));
@@ -480,6 +613,7 @@ static void st7735_draw_line(int x0, int y0, int x1, int y1, uint16_t color)
             y0 += sy;
         }
     }
+    PERF_TRACE_END(PERF_DRAW_LINE);
 }
 
 static void draw_tile_numeric(uint16_t x, uint16_t y, uint16_t w,
@@ -562,80 +696,220 @@ static void draw_main_screen(const ui_state_t *s)
     st7735_draw_string(4, 116, s->edit_mode ? "MODE:EDIT" : "MODE:NAV", COLOR_YELLOW);
 }
 
-static void draw_settings_screen(const ui_state_t *s)
+static const char *const settings_names[SET_COUNT] = {
+    [SET_CAP_CHARGE] = "CAP CHARGE",
+    [SET_MAX_CHARGE_CURRENT] = "MAX I",
+    [SET_MAX_CHARGE_POWER] = "MAX P",
+    [SET_BUZZER] = "BUZZER",
+    [SET_SAVE_MODE] = "SAVE",
+#if CONFIG_SPOT_PERF_TRACE
+    [SET_DIAG] = "DIAG",
+#endif
+    [SET_EXIT] = "EXIT",
+};
+
+static void format_setting_value(const ui_state_t *s, int item, char *out, size_t len)
+{
+    out[0] = '\0';
+    switch (item) {
+        case SET_CAP_CHARGE:
+            snprintf(out, len, "%s", s->cap_charge_on ? "ON" : "OFF");
+            break;
+        case SET_MAX_CHARGE_CURRENT:
+            format_1decimal(out, len, s->max_charge_current_tenths);
+            break;
+        case SET_MAX_CHARGE_POWER:
+            snprintf(out, len, "%dW", s->max_charge_power);
+            break;
+        case SET_BUZZER:
+            snprintf(out, len, "%s", s->buzzer_on ? "ON" : "OFF");
+            break;
+        case SET_SAVE_MODE:
+            snprintf(out, len, "%s", s->save_mode ? "SAVE" : "NO SAVE");
+            break;
+#if CONFIG_SPOT_PERF_TRACE
+        case SET_DIAG:
+            snprintf(out, len, "OPEN");
+            break;
+#endif
+        case SET_EXIT:
+            snprintf(out, len, "BACK");
+            break;
+        default:
+            break;
+    }
+}
+
+static void draw_settings_row(const ui_state_t *s, int item, uint16_t y, uint16_t w, bool sel)
 {
     char val[16];
-    const char *names[SET_COUNT] = {
-        "CAP CHARGE",
-        "MAX I",
-        "MAX P",
-        "BUZZER",
-        "SAVE",
-        "EXIT",
-    };
 
-    st7735_fill_screen(COLOR_BLACK);
-    st7735_fill_rect(0, 0, 160, 12, COLOR_BLUE);
-    st7735_draw_string(4, 2, "SETTINGS", COLOR_WHITE);
-
-    for (int i = 0; i < SET_COUNT; i++) {
-        int y = 14 + i * 18;
-        bool sel = (i == s->settings_selected);
-        if (sel) {
-            st7735_fill_rect(0, y - 1, 160, 16, COLOR_NAVY);
-        }
+    st7735_fill_rect(0, y - 1, w, 16, sel ? COLOR_NAVY : COLOR_BLACK);
+    st7735_draw_string(4, y + 3, settings_names[item], COLOR_WHITE);
 
-        st7735_draw_string(4, y + 3, names[i], COLOR_WHITE);
-
-        val[0] = '\0';
-        switch (i) {
-            case SET_CAP_CHARGE:
-                snprintf(val, sizeof(val), "%s", s->cap_charge_on ? "ON" : "OFF");
-                break;
-            case SET_MAX_CHARGE_CURRENT:
-                format_1decimal(val, sizeof(val), s->max_charge_current_tenths);
-                break;
-            case SET_MAX_CHARGE_POWER:
-                snprintf(val, sizeof(val), "%dW", s->max_charge_power);
-                break;
-            case SET_BUZZER:
-                snprintf(val, sizeof(val), "%s", s->buzzer_on ? "ON" : "OFF");
-                break;
-            case SET_SAVE_MODE:
-                snprintf(val, sizeof(val), "%s", s->save_mode ? "SAVE" : "NO SAVE");
-                break;
-            case SET_EXIT:
-                snprintf(val, sizeof(val), "BACK");
-                break;
-            default:
-                break;
-        }
+    format_setting_value(s, item, val, sizeof(val));
+    st7735_draw_string(98, y + 3, val, sel && s->edit_mode ? COLOR_YELLOW : COLOR_WHITE);
+    if (sel && s->edit_mode && item != SET_EXIT) {
+        st7735_draw_string(84, y + 3, "*", COLOR_YELLOW);
+    }
+}
 
-        st7735_draw_string(98, y + 3, val, sel && s->edit_mode ? COLOR_YELLOW : COLOR_WHITE);
-        if (sel && s->edit_mode && i != SET_EXIT) {
-            st7735_draw_string(84, y + 3, "*", COLOR_YELLOW);
-        }
+/*
+ * Windowed list below a fixed header. Only the rows whose content can have
+ * changed are repainted: the previous and current selection while the window
+ * stays put, and the visible rows once it moves. The ST7735 VSCRDEF/VSCRSADD
+ * scroll runs along the panel's gate lines, which MADCTL 0x60 (MV set) maps to
+ * the horizontal axis, so it cannot shift this list; row repaints stand in.
+ */
+typedef void (*list_row_fn)(const ui_state_t *s, int item, uint16_t y, uint16_t w, bool sel);
+
+typedef struct {
+    uint16_t y;
+    uint16_t row_h;
+    int rows;
+    int count;
+    int top;
+    int drawn_top;
+    int drawn_sel;
+    list_row_fn draw_row;
+} list_view_t;
+
+#define LIST_SCROLLBAR_W 3
+
+static void list_view_invalidate(list_view_t *lv)
+{
+    lv->drawn_top = -1;
+    lv->drawn_sel = -1;
+}
+
+static void list_view_follow(list_view_t *lv, int sel)
+{
+    if (sel < lv->top) {
+        lv->top = sel;
+    } else if (sel >= lv->top + lv->rows) {
+        lv->top = sel - lv->rows + 1;
     }
+    lv->top = clamp_i(lv->top, 0, lv->count > lv->rows ? lv->count - lv->rows : 0);
 }
 
-static void render_ui(const ui_state_t *s)
+static uint16_t list_view_row_width(const list_view_t *lv)
 {
-    if (s->screen == SCREEN_MAIN) {
-        draw_main_screen(s);
+    return lv->count > lv->rows ? LCD_WIDTH - LIST_SCROLLBAR_W : LCD_WIDTH;
+}
+
+static void list_view_draw_row(const list_view_t *lv, const ui_state_t *s, int item, int sel)
+{
+    if (item < lv->top || item >= lv->top + lv->rows || item >= lv->count) {
+        return;
+    }
+    uint16_t y = lv->y + (item - lv->top) * lv->row_h;
+    lv->draw_row(s, item, y, list_view_row_width(lv), item == sel);
+}
+
+static void list_view_draw_scrollbar(const list_view_t *lv)
+{
+    if (lv->count <= lv->rows) {
+        return;
+    }
+
+    uint16_t x = LCD_WIDTH - LIST_SCROLLBAR_W + 1;
+    uint16_t track_h = lv->rows * lv->row_h;
+    uint16_t thumb_h = track_h * lv->rows / lv->count;
+    uint16_t thumb_y = lv->y + track_h * lv->top / lv->count;
+    st7735_fill_rect(x, lv->y, LIST_SCROLLBAR_W - 1, track_h, COLOR_DARKGRAY);
+    st7735_fill_rect(x, thumb_y, LIST_SCROLLBAR_W - 1, thumb_h, COLOR_WHITE);
+}
+
+static void list_view_draw(list_view_t *lv, const ui_state_t *s, int sel)
+{
+    list_view_follow(lv, sel);
+
+    if (lv->top != lv->drawn_top) {
+        for (int i = lv->top; i < lv->top + lv->rows; i++) {
+            list_view_draw_row(lv, s, i, sel);
+        }
+        list_view_draw_scrollbar(lv);
     } else {
-        draw_settings_screen(s);
+        if (lv->drawn_sel != sel) {
+            list_view_draw_row(lv, s, lv->drawn_sel, sel);
+        }
+        list_view_draw_row(lv, s, sel, sel);
     }
+
+    lv->drawn_top = lv->top;
+    lv->drawn_sel = sel;
 }
 
-static int clamp_i(int v, int lo, int hi)
+static list_view_t settings_list = {
+    .y = 14,
+    .row_h = 18,
+    .rows = (LCD_HEIGHT - 14) / 18,
+    .count = SET_COUNT,
+    .top = 0,
+    .drawn_top = -1,
+    .drawn_sel = -1,
+    .draw_row = draw_settings_row,
+};
+
+static void draw_settings_screen(const ui_state_t *s, bool full)
 {
-    if (v < lo) {
-        return lo;
+    if (full) {
+        st7735_fill_screen(COLOR_BLACK);
+        st7735_fill_rect(0, 0, 160, 12, COLOR_BLUE);
+        st7735_draw_string(4, 2, "SETTINGS", COLOR_WHITE);
+        list_view_invalidate(&settings_list);
     }
-    if (v > hi) {
-        return hi;
+
+    list_view_draw(&settings_list, s, s->settings_selected);
+}
+
+#if CONFIG_SPOT_PERF_TRACE
+static void draw_diag_screen(bool full)
+{
+    char line[32];
+
+    if (full) {
+        st7735_fill_screen(COLOR_BLACK);
+        st7735_fill_rect(0, 0, 160, 12, COLOR_ORANGE);
+        st7735_draw_string(4, 2, "DIAG    p50  p99  max", COLOR_BLACK);
     }
-    return v;
+
+    /* Fixed-width fields: the glyph background overwrites the previous values. */
+    uint16_t y = 14;
+    for (int i = 0; i < PERF_COUNT; i++) {
+        perf_hist_t h;
+        perf_trace_snapshot(i, &h);
+        snprintf(line, sizeof(line), "%-6s%5lu%5lu%5lu", perf_trace_name(i),
+                 (unsigned long)perf_trace_percentile(&h, 50),
+                 (unsigned long)perf_trace_percentile(&h, 99),
+                 (unsigned long)h.max_us);
+        st7735_draw_string(4, y, line, COLOR_WHITE);
+        y += 9;
+    }
+
+    uint32_t bytes, txns;
+    perf_trace_spi_counts(&bytes, &txns);
+    snprintf(line, sizeof(line), "SPI %8luB %7lut", (unsigned long)bytes, (unsigned long)txns);
+    st7735_draw_string(4, y, line, COLOR_CYAN);
+}
+#endif
+
+static void render_ui(const ui_state_t *s)
+{
+    static int drawn_screen = -1;
+    PERF_TRACE_BEGIN(PERF_RENDER_UI);
+
+    if (s->screen == SCREEN_MAIN) {
+        draw_main_screen(s);
+#if CONFIG_SPOT_PERF_TRACE
+    } else if (s->screen == SCREEN_DIAG) {
+        draw_diag_screen(drawn_screen != (int)s->screen);
+#endif
+    } else {
+        draw_settings_screen(s, drawn_screen != (int)s->screen);
+    }
+    drawn_screen = s->screen;
+    PERF_TRACE_END(PERF_RENDER_UI);
 }
 
 static bool apply_main_steps(ui_state_t *s, int steps)
@@ -725,6 +999,11 @@ static bool apply_encoder_steps(ui_state_t *s, int steps)
     if (s->screen == SCREEN_MAIN) {
         return apply_main_steps(s, steps);
     }
+#if CONFIG_SPOT_PERF_TRACE
+    if (s->screen == SCREEN_DIAG) {
+        return false;
+    }
+#endif
     return apply_settings_steps(s, steps);
 }
 
@@ -740,6 +1019,18 @@ static bool handle_button_press(ui_state_t *s)
         return true;
     }
 
+#if CONFIG_SPOT_PERF_TRACE
+    if (s->screen == SCREEN_DIAG) {
+        s->screen = SCREEN_SETTINGS;
+        return true;
+    }
+
+    if (!s->edit_mode && s->settings_selected == SET_DIAG) {
+        s->screen = SCREEN_DIAG;
+        return true;
+    }
+#endif
+
     if (!s->edit_mode && s->settings_selected == SET_EXIT) {
         s->screen = SCREEN_MAIN;
         s->edit_mode = false;
@@ -750,6 +1041,62 @@ static bool handle_button_press(ui_state_t *s)
     return true;
 }
 
+static void emit_ui_snapshot(const ui_state_t *s)
+{
+    telem_ui_t snap = {
+        .screen = (uint8_t)s->screen,
+        .edit_mode = s->edit_mode,
+        .main_selected = (uint8_t)s->main_selected,
+        .settings_selected = (uint8_t)s->settings_selected,
+        .pulse1_tenths = (uint16_t)s->pulse1_tenths,
+        .pulse2_tenths = (uint16_t)s->pulse2_tenths,
+        .interval_tenths = (uint16_t)s->interval_tenths,
+        .auto_weld_tenths = (uint16_t)s->auto_weld_tenths,
+        .charge_cent = (uint16_t)s->charge_cent,
+        .cap_charge_on = (uint8_t)s->cap_charge_on,
+        .buzzer_on = (uint8_t)s->buzzer_on,
+        .save_mode = (uint8_t)s->save_mode,
+        .max_charge_power = (uint8_t)s->max_charge_power,
+        .max_charge_current_tenths = (uint16_t)s->max_charge_current_tenths,
+    };
+    telemetry_put(TELEM_PRODUCER_UI, TELEM_UI, &snap, sizeof(snap));
+}
+
+static void power_init(void)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = 40,
+        .light_sleep_enable = true,
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+
+    /* Held by ui_task except while asleep, so detents never race a light sleep entry. */
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ui_active", &ui_pm_lock));
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(ui_pm_lock));
+#endif
+}
+
+/*
+ * Blocks ui_task until the encoder or switch moves. With the PM lock released
+ * and no other work pending, automatic light sleep takes the chip down.
+ */
+static void idle_sleep(void)
+{
+    backlight_fade(0, BACKLIGHT_FADE_MS, LEDC_FADE_WAIT_DONE);
+    ESP_LOGI(TAG, "Idle, sleeping until input");
+
+    wake_arm();
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_release(ui_pm_lock));
+#endif
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(ui_pm_lock));
+#endif
+}
+
 static void ui_task(void *arg)
 {
     (void)arg;
@@ -758,8 +1105,15 @@ static void ui_task(void *arg)
     int8_t accum = 0;
     int sw_last = 1;
     bool dirty = true;
+    bool dimmed = false;
+    TickType_t last_input = last_wake;
+#if CONFIG_SPOT_PERF_TRACE
+    TickType_t last_diag = 0;
+#endif
 
     while (1) {
+        PERF_TRACE_BEGIN(PERF_UI_INPUT);
+        bool input = false;
         int8_t d = encoder_delta;
         if (d != 0) {
             d = encoder_delta;
@@ -768,6 +1122,10 @@ static void ui_task(void *arg)
             accum = (int8_t)(accum + d);
             int steps = accum / 4;
             accum = (int8_t)(accum % 4);
+            /* A bounce short of a full detent is not activity. */
+            if (steps != 0) {
+                input = true;
+            }
             if (apply_encoder_steps(&g_ui, steps)) {
                 dirty = true;
             }
@@ -775,17 +1133,57 @@ static void ui_task(void *arg)
 
         int sw = gpio_get_level(ENC_PIN_SW);
         if (sw_last == 1 && sw == 0) {
+            input = true;
             if (handle_button_press(&g_ui)) {
                 dirty = true;
             }
-            ESP_LOGI(TAG, "screen=%d mode=%s main=%d set=%d", g_ui.screen,
+            ESP_LOGD(TAG, "screen=%d mode=%s main=%d set=%d", g_ui.screen,
                      g_ui.edit_mode ? "EDIT" : "NAV", g_ui.main_selected, g_ui.settings_selected);
         }
         sw_last = sw;
+        PERF_TRACE_END(PERF_UI_INPUT);
+
+        if (weld_jitter_active()) {
+            dirty = true;
+        }
+
+#if CONFIG_SPOT_PERF_TRACE
+        if (g_ui.screen == SCREEN_DIAG && xTaskGetTickCount() - last_diag >= pdMS_TO_TICKS(500)) {
+            last_diag = xTaskGetTickCount();
+            dirty = true;
+        }
+#endif
+
+        if (input) {
+            emit_ui_snapshot(&g_ui);
+        }
 
         if (dirty) {
             render_ui(&g_ui);
             dirty = false;
+            if (wake_time_us != 0) {
+                ESP_LOGI(TAG, "wake-to-frame %lld us", (long long)(esp_timer_get_time() - wake_time_us));
+                wake_time_us = 0;
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if (input) {
+            last_input = now;
+            if (dimmed) {
+                ESP_ERROR_CHECK(ledc_fade_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0));
+                backlight_fade(BACKLIGHT_DUTY, BACKLIGHT_WAKE_FADE_MS, LEDC_FADE_NO_WAIT);
+                dimmed = false;
+            }
+        } else if (!dimmed && now - last_input >= pdMS_TO_TICKS(IDLE_DIM_MS)) {
+            backlight_fade(BACKLIGHT_DIM_DUTY, BACKLIGHT_FADE_MS, LEDC_FADE_NO_WAIT);
+            dimmed = true;
+        } else if (dimmed && now - last_input >= pdMS_TO_TICKS(IDLE_SLEEP_MS) && !weld_jitter_active()) {
+            /* last_input stays put: a wake without a detent or press sleeps again. */
+            idle_sleep();
+            last_wake = xTaskGetTickCount();
+            dirty = true;
+            continue;
         }
 
         vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(30));
@@ -794,7 +1192,28 @@ static void ui_task(void *arg)
 
 void app_main(void)
 {
+    perf_trace_init();
+    telemetry_init();
+    power_init();
     display_init();
     encoder_init();
-    xTaskCreate(ui_task, "ui_task", 6144, NULL, 5, NULL);
+    weld_init(PIN_WELD_OUT);
+    xTaskCreatePinnedToCore(ui_task, "ui_task", 6144, NULL, PRIO_UI, &ui_task_handle, UI_CORE);
+
+#if CONFIG_SPOT_WELD_JITTER_TEST
+    weld_jitter_cfg_t jitter_cfg = {
+        .capture_gpio = CONFIG_SPOT_JITTER_CAPTURE_GPIO,
+        .stimulus_gpio = ENC_PIN_A,
+        .sequences = CONFIG_SPOT_JITTER_SEQUENCES,
+        .tolerance_ns = CONFIG_SPOT_JITTER_TOLERANCE_US * 1000,
+        .start_budget_ns = CONFIG_SPOT_JITTER_START_BUDGET_US * 1000,
+        .stimulus_period_us = CONFIG_SPOT_JITTER_STIMULUS_US,
+        .seq = {
+            .pulse1_us = g_ui.pulse1_tenths * 100,
+            .interval_us = g_ui.interval_tenths * 100,
+            .pulse2_us = g_ui.pulse2_tenths * 100,
+        },
+    };
+    weld_jitter_start(&jitter_cfg);
+#endif
 }
\ No newline at end of file
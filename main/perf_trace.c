@@ -0,0 +1,175 @@
+#include "perf_trace.h"
+
+#if CONFIG_SPOT_PERF_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_err.h"
+#include "esp_log.h"
+
+static const char *TAG = "perf";
+
+static perf_hist_t hists[PERF_COUNT];
+static volatile uint32_t spi_bytes;
+static volatile uint32_t spi_transactions;
+
+/*
+ * perf_trace_reset() only bumps reset_gen. Each writer zeroes its own data the
+ * next time it records and sees a generation it has not applied yet, so a
+ * reset from the console never races a writer's read-modify-write.
+ */
+static volatile uint32_t reset_gen;
+static uint32_t hist_gen[PERF_COUNT];
+static uint32_t spi_gen;
+
+static const char *const names[PERF_COUNT] = {
+    [PERF_RENDER_UI] = "RENDER",
+    [PERF_UI_INPUT] = "INPUT",
+    [PERF_ENCODER_ISR] = "ENCISR",
+    [PERF_SET_ADDR_WINDOW] = "ADDRW",
+    [PERF_FILL_RECT] = "FILL",
+    [PERF_DRAW_RECT] = "RECT",
+    [PERF_FILL_SCREEN] = "SCREEN",
+    [PERF_DRAW_CHAR] = "CHAR",
+    [PERF_DRAW_STRING] = "STRING",
+    [PERF_DRAW_PIXEL] = "PIXEL",
+    [PERF_DRAW_LINE] = "LINE",
+};
+
+void IRAM_ATTR perf_trace_record(perf_trace_id_t id, uint32_t us)
+{
+    perf_hist_t *h = &hists[id];
+    uint32_t gen = reset_gen;
+    if (hist_gen[id] != gen) {
+        *h = (perf_hist_t){0};
+        hist_gen[id] = gen;
+    }
+
+    int b = us == 0 ? 0 : 32 - __builtin_clz(us);
+    if (b >= PERF_TRACE_BUCKETS) {
+        b = PERF_TRACE_BUCKETS - 1;
+    }
+
+    h->buckets[b]++;
+    h->total_us += us;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+    h->count++;
+}
+
+void perf_trace_spi(uint32_t bytes)
+{
+    uint32_t gen = reset_gen;
+    if (spi_gen != gen) {
+        spi_bytes = 0;
+        spi_transactions = 0;
+        spi_gen = gen;
+    }
+    spi_bytes += bytes;
+    spi_transactions++;
+}
+
+void perf_trace_reset(void)
+{
+    reset_gen++;
+}
+
+const char *perf_trace_name(perf_trace_id_t id)
+{
+    return names[id];
+}
+
+void perf_trace_snapshot(perf_trace_id_t id, perf_hist_t *out)
+{
+    /* Not recorded since the last reset: report it empty. */
+    if (hist_gen[id] != reset_gen) {
+        *out = (perf_hist_t){0};
+        return;
+    }
+    memcpy(out, &hists[id], sizeof(*out));
+}
+
+uint32_t perf_trace_percentile(const perf_hist_t *h, int pct)
+{
+    if (h->count == 0) {
+        return 0;
+    }
+
+    uint32_t want = (uint32_t)(((uint64_t)h->count * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (int b = 0; b < PERF_TRACE_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= want) {
+            uint32_t upper = b == 0 ? 1 : (1u << b);
+            return upper < h->max_us ? upper : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+void perf_trace_spi_counts(uint32_t *bytes, uint32_t *transactions)
+{
+    if (spi_gen != reset_gen) {
+        *bytes = 0;
+        *transactions = 0;
+        return;
+    }
+    *bytes = spi_bytes;
+    *transactions = spi_transactions;
+}
+
+static int perf_cmd(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        perf_trace_reset();
+        return 0;
+    }
+
+    printf("%-8s %8s %8s %8s %8s %8s\n", "name", "count", "avg", "p50", "p99", "max");
+    for (int i = 0; i < PERF_COUNT; i++) {
+        perf_hist_t h;
+        perf_trace_snapshot(i, &h);
+        uint32_t avg = h.count ? (uint32_t)(h.total_us / h.count) : 0;
+        printf("%-8s %8lu %8lu %8lu %8lu %8lu\n", names[i], (unsigned long)h.count,
+               (unsigned long)avg, (unsigned long)perf_trace_percentile(&h, 50),
+               (unsigned long)perf_trace_percentile(&h, 99), (unsigned long)h.max_us);
+    }
+
+    uint32_t bytes, txns;
+    perf_trace_spi_counts(&bytes, &txns);
+    printf("spi bytes=%lu transactions=%lu\n", (unsigned long)bytes, (unsigned long)txns);
+    return 0;
+}
+
+void perf_trace_init(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "spot>";
+
+#if CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+#else
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
+#endif
+
+    const esp_console_cmd_t cmd = {
+        .command = "perf",
+        .help = "Print timing histograms (us) and SPI counters; 'perf reset' clears them",
+        .hint = "[reset]",
+        .func = perf_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+    ESP_ERROR_CHECK(esp_console_register_help_command());
+
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    ESP_LOGI(TAG, "Tracing enabled, 'perf' command registered");
+}
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef enum {
+    PERF_RENDER_UI = 0,
+    PERF_UI_INPUT,
+    PERF_ENCODER_ISR,
+    PERF_SET_ADDR_WINDOW,
+    PERF_FILL_RECT,
+    PERF_DRAW_RECT,
+    PERF_FILL_SCREEN,
+    PERF_DRAW_CHAR,
+    PERF_DRAW_STRING,
+    PERF_DRAW_PIXEL,
+    PERF_DRAW_LINE,
+    PERF_COUNT,
+} perf_trace_id_t;
+
+/* Bucket b counts durations in [2^(b-1), 2^b) us; bucket 0 is < 1 us. */
+#define PERF_TRACE_BUCKETS 16
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[PERF_TRACE_BUCKETS];
+} perf_hist_t;
+
+#if CONFIG_SPOT_PERF_TRACE
+
+#include "esp_timer.h"
+
+/*
+ * Every histogram and counter has exactly one writer (the ISR or ui_task), so
+ * recording is a handful of plain stores. Readers may see a sample that is
+ * half-applied; the numbers are for diagnostics, not accounting. A reset is
+ * only a request: each writer clears its own data on its next sample.
+ */
+#define PERF_TRACE_BEGIN(id) const int64_t perf_t0_##id = esp_timer_get_time()
+#define PERF_TRACE_END(id) perf_trace_record((id), (uint32_t)(esp_timer_get_time() - perf_t0_##id))
+#define PERF_TRACE_SPI(bytes) perf_trace_spi((uint32_t)(bytes))
+
+void perf_trace_init(void);
+void perf_trace_record(perf_trace_id_t id, uint32_t us);
+void perf_trace_spi(uint32_t bytes);
+void perf_trace_reset(void);
+
+const char *perf_trace_name(perf_trace_id_t id);
+void perf_trace_snapshot(perf_trace_id_t id, perf_hist_t *out);
+uint32_t perf_trace_percentile(const perf_hist_t *h, int pct);
+void perf_trace_spi_counts(uint32_t *bytes, uint32_t *transactions);
+
+#else
+
+#define PERF_TRACE_BEGIN(id) do { } while (0)
+#define PERF_TRACE_END(id) do { } while (0)
+#define PERF_TRACE_SPI(bytes) do { } while (0)
+
+static inline void perf_trace_init(void) { }
+
+#endif
@@ -0,0 +1,257 @@
+#include "telemetry.h"
+
+#if CONFIG_SPOT_TELEMETRY
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "exec_model.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "perf_trace.h"
+
+#if CONFIG_SPOT_TELEMETRY_USB_SERIAL_JTAG
+#include "driver/usb_serial_jtag.h"
+#else
+#include "driver/uart.h"
+#endif
+
+#define TELEM_RING_BYTES 2048
+#define TELEM_RECORD_HDR 6
+#define TELEM_FRAME_OVERHEAD 11
+#define TELEM_BATCH_BYTES 4096
+#define TELEM_DRAIN_MS 20
+#define TELEM_STATS_MS 1000
+#define TELEM_UART_TX_BYTES (TELEM_BATCH_BYTES * 2)
+
+static const char *TAG = "telemetry";
+
+/*
+ * Single-producer single-consumer byte ring. head and tail run freely and are
+ * masked on access; the producer publishes a whole record with one release
+ * store of head, so the consumer never sees a partial record.
+ */
+typedef struct {
+    uint8_t buf[TELEM_RING_BYTES];
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+} telem_ring_t;
+
+static telem_ring_t rings[TELEM_PRODUCER_COUNT];
+static uint8_t batch[TELEM_BATCH_BYTES];
+static size_t batch_len;
+static uint8_t frame_seq;
+static telem_stats_t stats;
+static TaskHandle_t telem_task_handle;
+
+static void ring_copy_in(telem_ring_t *r, uint32_t pos, const uint8_t *src, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        r->buf[(pos + i) & (TELEM_RING_BYTES - 1)] = src[i];
+    }
+}
+
+static void ring_copy_out(const telem_ring_t *r, uint32_t pos, uint8_t *dst, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = r->buf[(pos + i) & (TELEM_RING_BYTES - 1)];
+    }
+}
+
+bool telemetry_put(telem_producer_t producer, telem_type_t type, const void *payload, uint8_t len)
+{
+    telem_ring_t *r = &rings[producer];
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t need = TELEM_RECORD_HDR + len;
+
+    if (TELEM_RING_BYTES - (head - tail) < need) {
+        atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t t_us = (uint32_t)esp_timer_get_time();
+    uint8_t hdr[TELEM_RECORD_HDR] = {(uint8_t)type, len};
+    memcpy(&hdr[2], &t_us, sizeof(t_us));
+    ring_copy_in(r, head, hdr, sizeof(hdr));
+    ring_copy_in(r, head + sizeof(hdr), payload, len);
+    atomic_store_explicit(&r->head, head + need, memory_order_release);
+    if (telem_task_handle != NULL) {
+        xTaskNotifyGive(telem_task_handle);
+    }
+    return true;
+}
+
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void transport_init(void)
+{
+#if CONFIG_SPOT_TELEMETRY_USB_SERIAL_JTAG
+    usb_serial_jtag_driver_config_t cfg = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    cfg.tx_buffer_size = TELEM_BATCH_BYTES;
+    ESP_ERROR_CHECK(usb_serial_jtag_driver_install(&cfg));
+#else
+    uart_config_t cfg = {
+        .baud_rate = CONFIG_SPOT_TELEMETRY_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        /* XTAL keeps the baud rate exact while DFS moves the APB clock. */
+        .source_clk = UART_SCLK_XTAL,
+    };
+    ESP_ERROR_CHECK(uart_driver_install(CONFIG_SPOT_TELEMETRY_UART_NUM, 256, TELEM_UART_TX_BYTES, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(CONFIG_SPOT_TELEMETRY_UART_NUM, &cfg));
+    ESP_ERROR_CHECK(uart_set_pin(CONFIG_SPOT_TELEMETRY_UART_NUM, CONFIG_SPOT_TELEMETRY_TX_GPIO,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+#endif
+}
+
+/*
+ * One driver write per batch. uart_write_bytes() blocks until everything is
+ * queued, so a batch the TX buffer cannot take is dropped whole rather than
+ * stalling the drain when the batch rate outruns the line rate.
+ */
+static void transport_flush(void)
+{
+    if (batch_len == 0) {
+        return;
+    }
+#if CONFIG_SPOT_TELEMETRY_USB_SERIAL_JTAG
+    int written = usb_serial_jtag_write_bytes(batch, batch_len, pdMS_TO_TICKS(100));
+#else
+    size_t room = 0;
+    ESP_ERROR_CHECK(uart_get_tx_buffer_free_size(CONFIG_SPOT_TELEMETRY_UART_NUM, &room));
+    int written = 0;
+    if (room >= batch_len) {
+        written = uart_write_bytes(CONFIG_SPOT_TELEMETRY_UART_NUM, batch, batch_len);
+    }
+#endif
+    if (written < (int)batch_len) {
+        stats.tx_dropped_bytes += batch_len - (written > 0 ? (size_t)written : 0);
+    }
+    batch_len = 0;
+}
+
+static void batch_frame(uint8_t type, uint32_t t_us, const uint8_t *payload, uint8_t len)
+{
+    size_t frame_len = TELEM_FRAME_OVERHEAD + len;
+    if (batch_len + frame_len > sizeof(batch)) {
+        transport_flush();
+    }
+
+    uint8_t *f = &batch[batch_len];
+    f[0] = 0xA5;
+    f[1] = 0x5A;
+    f[2] = type;
+    f[3] = len;
+    f[4] = frame_seq++;
+    memcpy(&f[5], &t_us, sizeof(t_us));
+    memcpy(&f[9], payload, len);
+    uint16_t crc = crc16_ccitt(&f[2], 7 + len);
+    f[9 + len] = crc & 0xFF;
+    f[10 + len] = crc >> 8;
+
+    batch_len += frame_len;
+    stats.frames++;
+    stats.bytes += frame_len;
+}
+
+static void drain_ring(telem_ring_t *r)
+{
+    uint8_t rec[TELEM_RECORD_HDR + UINT8_MAX];
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    while (tail != head) {
+        ring_copy_out(r, tail, rec, TELEM_RECORD_HDR);
+        uint8_t len = rec[1];
+        ring_copy_out(r, tail + TELEM_RECORD_HDR, &rec[TELEM_RECORD_HDR], len);
+
+        uint32_t t_us;
+        memcpy(&t_us, &rec[2], sizeof(t_us));
+        batch_frame(rec[0], t_us, &rec[TELEM_RECORD_HDR], len);
+        tail += TELEM_RECORD_HDR + len;
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+    }
+}
+
+static void emit_periodic(void)
+{
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    for (int i = 0; i < TELEM_PRODUCER_COUNT; i++) {
+        stats.dropped[i] = atomic_load_explicit(&rings[i].dropped, memory_order_relaxed);
+    }
+    batch_frame(TELEM_STATS, now, (const uint8_t *)&stats, sizeof(stats));
+
+#if CONFIG_SPOT_PERF_TRACE
+    /* count and max_us per trace point, then SPI bytes and transactions. */
+    uint32_t perf[PERF_COUNT * 2 + 2];
+    for (int i = 0; i < PERF_COUNT; i++) {
+        perf_hist_t h;
+        perf_trace_snapshot(i, &h);
+        perf[i * 2] = h.count;
+        perf[i * 2 + 1] = h.max_us;
+    }
+    perf_trace_spi_counts(&perf[PERF_COUNT * 2], &perf[PERF_COUNT * 2 + 1]);
+    batch_frame(TELEM_PERF, now, (const uint8_t *)perf, sizeof(perf));
+#endif
+}
+
+/*
+ * Sleeps on a notification from telemetry_put(), then waits TELEM_DRAIN_MS so
+ * one write carries a batch of records. Stats go out at most once per
+ * TELEM_STATS_MS and only after other frames, so an idle stream leaves the
+ * chip free to light-sleep.
+ */
+static void telemetry_task(void *arg)
+{
+    (void)arg;
+    TickType_t last_stats = xTaskGetTickCount();
+    uint32_t frames_at_stats = 0;
+
+    while (1) {
+        for (int i = 0; i < TELEM_PRODUCER_COUNT; i++) {
+            drain_ring(&rings[i]);
+        }
+
+        if (stats.frames != frames_at_stats &&
+            xTaskGetTickCount() - last_stats >= pdMS_TO_TICKS(TELEM_STATS_MS)) {
+            last_stats = xTaskGetTickCount();
+            emit_periodic();
+            frames_at_stats = stats.frames;
+        }
+        transport_flush();
+
+        TickType_t wait = portMAX_DELAY;
+        if (stats.frames != frames_at_stats) {
+            TickType_t elapsed = xTaskGetTickCount() - last_stats;
+            wait = elapsed >= pdMS_TO_TICKS(TELEM_STATS_MS) ? 0 : pdMS_TO_TICKS(TELEM_STATS_MS) - elapsed;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        vTaskDelay(pdMS_TO_TICKS(TELEM_DRAIN_MS));
+    }
+}
+
+void telemetry_init(void)
+{
+    transport_init();
+    xTaskCreatePinnedToCore(telemetry_task, "telemetry", 4096, NULL, PRIO_TELEMETRY, &telem_task_handle, UI_CORE);
+    ESP_LOGI(TAG, "Telemetry stream started");
+}
+
+#endif
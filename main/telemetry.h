@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/*
+ * Wire format, little endian:
+ *
+ *   0xA5 0x5A | type u8 | len u8 | seq u8 | t_us u32 | payload[len] | crc16 u16
+ *
+ * seq counts frames modulo 256 so the host can spot gaps, t_us is the low
+ * 32 bits of esp_timer at the time the record was queued, and crc16 is
+ * CRC-16/CCITT-FALSE over type through the end of the payload.
+ * tools/telemetry/decode.py is the matching host decoder.
+ */
+
+typedef enum {
+    TELEM_CHARGE = 1,
+    TELEM_WELD = 2,
+    TELEM_UI = 3,
+    TELEM_PERF = 4,
+    TELEM_STATS = 5,
+} telem_type_t;
+
+/* One ring per producer, each with a single writing context. */
+typedef enum {
+    TELEM_PRODUCER_UI = 0,
+    TELEM_PRODUCER_WELD,
+    TELEM_PRODUCER_CHARGE,
+    TELEM_PRODUCER_COUNT,
+} telem_producer_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t voltage_mv;
+    uint16_t current_ma;
+} telem_charge_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t pulse1_us;
+    uint32_t interval_us;
+    uint32_t pulse2_us;
+} telem_weld_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t screen;
+    uint8_t edit_mode;
+    uint8_t main_selected;
+    uint8_t settings_selected;
+    uint16_t pulse1_tenths;
+    uint16_t pulse2_tenths;
+    uint16_t interval_tenths;
+    uint16_t auto_weld_tenths;
+    uint16_t charge_cent;
+    uint8_t cap_charge_on;
+    uint8_t buzzer_on;
+    uint8_t save_mode;
+    uint8_t max_charge_power;
+    uint16_t max_charge_current_tenths;
+} telem_ui_t;
+
+/*
+ * dropped counts records lost to a full ring; frames and bytes count what was
+ * framed for the transport, of which tx_dropped_bytes never went out: on UART
+ * a batch the TX buffer had no room for, on USB a failed or short write.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t dropped[TELEM_PRODUCER_COUNT];
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t tx_dropped_bytes;
+} telem_stats_t;
+
+#if CONFIG_SPOT_TELEMETRY
+
+void telemetry_init(void);
+
+/*
+ * Queues one record on the producer's ring and returns at once. A full ring
+ * drops the record and bumps that producer's drop counter, so this is safe to
+ * call from the real-time path. Call it from task context, not from an ISR: it
+ * wakes the drain task with a task notification. Only one context may write
+ * each producer.
+ */
+bool telemetry_put(telem_producer_t producer, telem_type_t type, const void *payload, uint8_t len);
+
+#else
+
+static inline void telemetry_init(void) { }
+
+static inline bool telemetry_put(telem_producer_t producer, telem_type_t type, const void *payload, uint8_t len)
+{
+    (void)producer;
+    (void)type;
+    (void)payload;
+    (void)len;
+    return false;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include "weld.h"
+
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "exec_model.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "telemetry.h"
+
+#if !CONFIG_GPTIMER_ISR_IRAM_SAFE || !CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM || !CONFIG_GPIO_CTRL_FUNC_IN_IRAM
+#error "weld_alarm_cb needs GPTIMER_ISR_IRAM_SAFE, GPTIMER_CTRL_FUNC_IN_IRAM and GPIO_CTRL_FUNC_IN_IRAM (see sdkconfig.defaults)"
+#endif
+
+#define WELD_TIMER_HZ (1 * 1000 * 1000)
+/* First edge is an alarm this many counts after start, so the ISR owns every edge. */
+#define WELD_LEAD_TICKS 5
+
+static const char *TAG = "weld";
+
+typedef enum {
+    WELD_IDLE = 0,
+    WELD_ARMED,
+    WELD_PULSE1,
+    WELD_INTERVAL,
+    WELD_PULSE2,
+    WELD_DONE,
+} weld_phase_t;
+
+static gptimer_handle_t weld_timer;
+static int weld_gpio = -1;
+static volatile weld_phase_t weld_phase = WELD_IDLE;
+static uint64_t weld_edges[4];
+static int64_t weld_fire_us;
+static volatile int64_t weld_start_us;
+static weld_seq_t weld_req;
+static TaskHandle_t weld_waiter;
+static TaskHandle_t weld_task_handle;
+static TaskHandle_t weld_init_waiter;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t weld_cpu_lock;
+static esp_pm_lock_handle_t weld_sleep_lock;
+#endif
+
+static bool IRAM_ATTR weld_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg)
+{
+    (void)edata;
+    (void)arg;
+    BaseType_t woken = pdFALSE;
+
+    switch (weld_phase) {
+        case WELD_ARMED: {
+            gpio_set_level(weld_gpio, 1);
+            weld_start_us = esp_timer_get_time();
+            gptimer_alarm_config_t alarm = {.alarm_count = weld_edges[1]};
+            gptimer_set_alarm_action(timer, &alarm);
+            weld_phase = WELD_PULSE1;
+            return false;
+        }
+        case WELD_PULSE1:
+            gpio_set_level(weld_gpio, 0);
+            if (weld_edges[2] != 0) {
+                gptimer_alarm_config_t alarm = {.alarm_count = weld_edges[2]};
+                gptimer_set_alarm_action(timer, &alarm);
+                weld_phase = WELD_INTERVAL;
+                return false;
+            }
+            break;
+        case WELD_INTERVAL: {
+            gpio_set_level(weld_gpio, 1);
+            gptimer_alarm_config_t alarm = {.alarm_count = weld_edges[3]};
+            gptimer_set_alarm_action(timer, &alarm);
+            weld_phase = WELD_PULSE2;
+            return false;
+        }
+        case WELD_PULSE2:
+            gpio_set_level(weld_gpio, 0);
+            break;
+        case WELD_IDLE:
+        case WELD_DONE:
+        default:
+            return false;
+    }
+
+    gptimer_stop(timer);
+    weld_phase = WELD_DONE;
+    vTaskNotifyGiveFromISR(weld_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+static void weld_hw_init(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << weld_gpio,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_set_level(weld_gpio, 0));
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+    gptimer_config_t timer_cfg = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = WELD_TIMER_HZ,
+        .intr_priority = WELD_INTR_LEVEL,
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_cfg, &weld_timer));
+
+    /* The alarm interrupt is allocated on the core that registers it. */
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = weld_alarm_cb,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(weld_timer, &cbs, NULL));
+
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "weld_cpu", &weld_cpu_lock));
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "weld_sleep", &weld_sleep_lock));
+#endif
+}
+
+static void weld_task(void *arg)
+{
+    (void)arg;
+
+    weld_hw_init();
+    xTaskNotifyGive(weld_init_waiter);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /*
+         * The timer and the PM locks are held for one sequence only, so DFS
+         * and light sleep can run between welds. gptimer_enable()'s own
+         * APB_FREQ_MAX lock only pins the CPU at 80 MHz; CPU_FREQ_MAX keeps the
+         * idle-exit hook from switching the clock before each alarm.
+         */
+#if CONFIG_PM_ENABLE
+        ESP_ERROR_CHECK(esp_pm_lock_acquire(weld_cpu_lock));
+        ESP_ERROR_CHECK(esp_pm_lock_acquire(weld_sleep_lock));
+#endif
+        ESP_ERROR_CHECK(gptimer_enable(weld_timer));
+        gptimer_alarm_config_t alarm = {.alarm_count = weld_edges[0]};
+        ESP_ERROR_CHECK(gptimer_set_raw_count(weld_timer, 0));
+        ESP_ERROR_CHECK(gptimer_set_alarm_action(weld_timer, &alarm));
+        ESP_ERROR_CHECK(gptimer_start(weld_timer));
+
+        /* Woken by the alarm ISR once it has stopped the timer in WELD_DONE. */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ESP_ERROR_CHECK(gptimer_disable(weld_timer));
+#if CONFIG_PM_ENABLE
+        ESP_ERROR_CHECK(esp_pm_lock_release(weld_sleep_lock));
+        ESP_ERROR_CHECK(esp_pm_lock_release(weld_cpu_lock));
+#endif
+
+        /*
+         * Queued after the last edge, since telemetry_put() enters a critical
+         * section to wake its task, and before WELD_IDLE lets weld_req change.
+         */
+        telem_weld_t ev = {
+            .pulse1_us = weld_req.pulse1_us,
+            .interval_us = weld_req.interval_us,
+            .pulse2_us = weld_req.pulse2_us,
+        };
+        telemetry_put(TELEM_PRODUCER_WELD, TELEM_WELD, &ev, sizeof(ev));
+
+        weld_phase = WELD_IDLE;
+        if (weld_waiter != NULL) {
+            xTaskNotifyGive(weld_waiter);
+        }
+    }
+}
+
+void weld_init(int gpio_num)
+{
+    weld_gpio = gpio_num;
+    weld_init_waiter = xTaskGetCurrentTaskHandle();
+    xTaskCreatePinnedToCore(weld_task, "weld_task", 3072, NULL, PRIO_WELD, &weld_task_handle, RT_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    ESP_LOGI(TAG, "Weld output on GPIO %d, core %d", gpio_num, RT_CORE);
+}
+
+esp_err_t weld_fire(const weld_seq_t *seq)
+{
+    if (seq->pulse1_us == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (weld_phase != WELD_IDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* A zero interval would alarm on the current count; merge into one pulse. */
+    weld_edges[0] = WELD_LEAD_TICKS;
+    if (seq->interval_us == 0 || seq->pulse2_us == 0) {
+        weld_edges[1] = weld_edges[0] + seq->pulse1_us + seq->pulse2_us;
+        weld_edges[2] = 0;
+    } else {
+        weld_edges[1] = weld_edges[0] + seq->pulse1_us;
+        weld_edges[2] = weld_edges[1] + seq->interval_us;
+        weld_edges[3] = weld_edges[2] + seq->pulse2_us;
+    }
+    weld_req = *seq;
+    weld_waiter = xTaskGetCurrentTaskHandle();
+    weld_start_us = 0;
+    weld_fire_us = esp_timer_get_time();
+    weld_phase = WELD_ARMED;
+    xTaskNotifyGive(weld_task_handle);
+    return ESP_OK;
+}
+
+uint32_t weld_start_latency_us(void)
+{
+    int64_t start = weld_start_us;
+    if (start < weld_fire_us) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(start - weld_fire_us);
+}
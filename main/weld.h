@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t pulse1_us;
+    uint32_t interval_us;
+    uint32_t pulse2_us;
+} weld_seq_t;
+
+/* Starts weld_task on RT_CORE and waits until its timer ISR is installed. */
+void weld_init(int gpio_num);
+
+/*
+ * Hands PULSE1 / INTERVAL / PULSE2 to weld_task and returns at once; weld_task
+ * starts the timer and the alarm ISR drives every edge of the output. The
+ * calling task receives a task notification once the output has gone low for
+ * the last time and the timer is disabled again. Returns
+ * ESP_ERR_INVALID_STATE while a sequence is running.
+ */
+esp_err_t weld_fire(const weld_seq_t *seq);
+
+/*
+ * Time from the last weld_fire() to its first output edge, stamped by the alarm
+ * ISR as it raises the output. UINT32_MAX if that edge has not happened.
+ */
+uint32_t weld_start_latency_us(void);
@@ -0,0 +1,308 @@
+#include "weld_jitter.h"
+
+#if CONFIG_SPOT_WELD_JITTER_TEST
+
+#include <stdlib.h>
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "exec_model.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "jitter_stats.h"
+#include "soc/soc_caps.h"
+
+#if SOC_MCPWM_SUPPORTED
+#include "driver/mcpwm_cap.h"
+#else
+#include "driver/rmt_rx.h"
+#include "freertos/semphr.h"
+#endif
+
+#define JITTER_MAX_EDGES 8
+
+static const char *TAG = "weld_jitter";
+
+static weld_jitter_cfg_t jcfg;
+static volatile bool jitter_active;
+static jitter_edge_t edges[JITTER_MAX_EDGES];
+static int stimulus_level = 1;
+
+#if SOC_MCPWM_SUPPORTED
+
+/* MCPWM capture: every edge is latched against a free-running APB-clocked timer. */
+static volatile int edge_count;
+
+static bool IRAM_ATTR capture_cb(mcpwm_cap_channel_handle_t chan, const mcpwm_capture_event_data_t *edata, void *arg)
+{
+    (void)chan;
+    (void)arg;
+    int n = edge_count;
+    if (n < JITTER_MAX_EDGES) {
+        edges[n].ticks = edata->cap_value;
+        edges[n].rising = edata->cap_edge == MCPWM_CAP_EDGE_POS;
+        edge_count = n + 1;
+    }
+    return false;
+}
+
+static uint32_t capture_init(void)
+{
+    mcpwm_cap_timer_handle_t cap_timer;
+    mcpwm_capture_timer_config_t timer_cfg = {
+        .group_id = 0,
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+    };
+    ESP_ERROR_CHECK(mcpwm_new_capture_timer(&timer_cfg, &cap_timer));
+
+    mcpwm_cap_channel_handle_t cap_chan;
+    mcpwm_capture_channel_config_t chan_cfg = {
+        .gpio_num = jcfg.capture_gpio,
+        .prescale = 1,
+        .flags.pos_edge = true,
+        .flags.neg_edge = true,
+    };
+    ESP_ERROR_CHECK(mcpwm_new_capture_channel(cap_timer, &chan_cfg, &cap_chan));
+
+    mcpwm_capture_event_callbacks_t cbs = {
+        .on_cap = capture_cb,
+    };
+    ESP_ERROR_CHECK(mcpwm_capture_channel_register_event_callbacks(cap_chan, &cbs, NULL));
+    ESP_ERROR_CHECK(mcpwm_capture_channel_enable(cap_chan));
+    ESP_ERROR_CHECK(mcpwm_capture_timer_enable(cap_timer));
+    ESP_ERROR_CHECK(mcpwm_capture_timer_start(cap_timer));
+
+    uint32_t hz = 0;
+    ESP_ERROR_CHECK(mcpwm_capture_timer_get_resolution(cap_timer, &hz));
+    return hz;
+}
+
+static void capture_arm(void)
+{
+    edge_count = 0;
+}
+
+static int capture_collect(void)
+{
+    return edge_count;
+}
+
+#else
+
+/*
+ * RMT receive for chips without MCPWM (ESP32-C3): the channel records how long
+ * each level lasted, and the edges are rebuilt from the first rising edge.
+ * Reception ends once the line has idled longer than any level in the
+ * sequence, so a longer sequence takes longer to collect.
+ */
+#define JITTER_RMT_HZ (1 * 1000 * 1000)
+#define JITTER_RMT_FILTER_NS 1000
+#define JITTER_RMT_IDLE_MARGIN_US 200
+
+static rmt_channel_handle_t rx_chan;
+static rmt_symbol_word_t rx_symbols[SOC_RMT_MEM_WORDS_PER_CHANNEL];
+static volatile size_t rx_count;
+static SemaphoreHandle_t rx_done;
+static rmt_receive_config_t rx_cfg;
+
+static bool IRAM_ATTR rx_done_cb(rmt_channel_handle_t chan, const rmt_rx_done_event_data_t *edata, void *arg)
+{
+    (void)chan;
+    (void)arg;
+    BaseType_t woken = pdFALSE;
+    rx_count = edata->num_symbols;
+    xSemaphoreGiveFromISR(rx_done, &woken);
+    return woken == pdTRUE;
+}
+
+static uint32_t capture_init(void)
+{
+    rx_done = xSemaphoreCreateBinary();
+
+    rmt_rx_channel_config_t chan_cfg = {
+        .gpio_num = jcfg.capture_gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = JITTER_RMT_HZ,
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+    };
+    ESP_ERROR_CHECK(rmt_new_rx_channel(&chan_cfg, &rx_chan));
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = rx_done_cb,
+    };
+    ESP_ERROR_CHECK(rmt_rx_register_event_callbacks(rx_chan, &cbs, NULL));
+    ESP_ERROR_CHECK(rmt_enable(rx_chan));
+
+    /* Same merge rule as weld_fire(): a zero INTERVAL or PULSE2 is one long pulse. */
+    const weld_seq_t *q = &jcfg.seq;
+    uint32_t longest = q->pulse1_us + q->pulse2_us;
+    if (q->interval_us != 0 && q->pulse2_us != 0) {
+        longest = q->pulse1_us;
+        if (q->interval_us > longest) {
+            longest = q->interval_us;
+        }
+        if (q->pulse2_us > longest) {
+            longest = q->pulse2_us;
+        }
+    }
+    rx_cfg.signal_range_min_ns = JITTER_RMT_FILTER_NS;
+    rx_cfg.signal_range_max_ns = (longest + JITTER_RMT_IDLE_MARGIN_US) * 1000;
+    return JITTER_RMT_HZ;
+}
+
+static void capture_arm(void)
+{
+    rx_count = 0;
+    ESP_ERROR_CHECK(rmt_receive(rx_chan, rx_symbols, sizeof(rx_symbols), &rx_cfg));
+}
+
+static int capture_collect(void)
+{
+    if (xSemaphoreTake(rx_done, pdMS_TO_TICKS(100)) != pdTRUE) {
+        /* Nothing arrived; cycling the channel cancels the pending receive. */
+        ESP_ERROR_CHECK(rmt_disable(rx_chan));
+        ESP_ERROR_CHECK(rmt_enable(rx_chan));
+        return 0;
+    }
+
+    /* The line idles low; a zero duration marks the end of the reception. */
+    int n = 0;
+    int level = 0;
+    bool started = false;
+    bool ended = false;
+    uint32_t t = 0;
+    for (size_t i = 0; i < rx_count && !ended; i++) {
+        const uint32_t dur[2] = {rx_symbols[i].duration0, rx_symbols[i].duration1};
+        const int lvl[2] = {rx_symbols[i].level0, rx_symbols[i].level1};
+        for (int h = 0; h < 2 && !ended; h++) {
+            if (lvl[h] != level) {
+                if (n < JITTER_MAX_EDGES) {
+                    edges[n].ticks = t;
+                    edges[n].rising = lvl[h] == 1;
+                    n++;
+                }
+                level = lvl[h];
+                started = true;
+            }
+            if (dur[h] == 0) {
+                ended = true;
+            } else if (started) {
+                t += dur[h];
+            }
+        }
+    }
+    /* Reception only ends on an idle line, so a trailing high level has fallen. */
+    if (level == 1 && n < JITTER_MAX_EDGES) {
+        edges[n].ticks = t;
+        edges[n].rising = false;
+        n++;
+    }
+    return n;
+}
+
+#endif
+
+static void stimulus_cb(void *arg)
+{
+    (void)arg;
+    stimulus_level = !stimulus_level;
+    gpio_set_level(jcfg.stimulus_gpio, stimulus_level);
+}
+
+static esp_timer_handle_t stimulus_start(void)
+{
+    /* Open drain against the encoder pull-up, so a closed contact is never driven high. */
+    ESP_ERROR_CHECK(gpio_set_direction(jcfg.stimulus_gpio, GPIO_MODE_INPUT_OUTPUT_OD));
+
+    esp_timer_handle_t timer;
+    esp_timer_create_args_t args = {
+        .callback = stimulus_cb,
+        .name = "enc_stim",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer, jcfg.stimulus_period_us));
+    return timer;
+}
+
+static void stimulus_stop(esp_timer_handle_t timer)
+{
+    ESP_ERROR_CHECK(esp_timer_stop(timer));
+    ESP_ERROR_CHECK(esp_timer_delete(timer));
+    gpio_set_level(jcfg.stimulus_gpio, 1);
+    ESP_ERROR_CHECK(gpio_set_direction(jcfg.stimulus_gpio, GPIO_MODE_INPUT));
+}
+
+static void weld_jitter_task(void *arg)
+{
+    (void)arg;
+
+    uint32_t tick_hz = capture_init();
+    size_t capacity = (size_t)jcfg.sequences * 3;
+    uint32_t *err_buf = malloc(capacity * sizeof(uint32_t));
+    if (err_buf == NULL) {
+        ESP_LOGE(TAG, "No memory for %d sequences", jcfg.sequences);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    const uint32_t nominal_us[3] = {jcfg.seq.pulse1_us, jcfg.seq.interval_us, jcfg.seq.pulse2_us};
+    jitter_stats_t st;
+    jitter_stats_init(&st, err_buf, capacity, tick_hz, nominal_us, jcfg.tolerance_ns, jcfg.start_budget_ns);
+
+    ESP_LOGI(TAG, "Running %d sequences P1=%luus INT=%luus P2=%luus, capture %luHz",
+             jcfg.sequences, (unsigned long)nominal_us[0], (unsigned long)nominal_us[1],
+             (unsigned long)nominal_us[2], (unsigned long)tick_hz);
+
+    esp_timer_handle_t stim = stimulus_start();
+    jitter_active = true;
+
+    for (int i = 0; i < jcfg.sequences; i++) {
+        capture_arm();
+        esp_err_t err = weld_fire(&jcfg.seq);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "weld_fire failed at %d: %s", i, esp_err_to_name(err));
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        /* Lets the final capture land and spaces the sequences apart. */
+        vTaskDelay(pdMS_TO_TICKS(2));
+        uint32_t start_us = weld_start_latency_us();
+        uint32_t start_ns = start_us > UINT32_MAX / 1000 ? UINT32_MAX : start_us * 1000;
+        jitter_stats_add(&st, start_ns, edges, capture_collect());
+    }
+
+    jitter_active = false;
+    stimulus_stop(stim);
+
+    uint32_t p50 = jitter_stats_percentile(&st, 500);
+    uint32_t p99 = jitter_stats_percentile(&st, 990);
+    uint32_t p999 = jitter_stats_percentile(&st, 999);
+    uint32_t max = jitter_stats_percentile(&st, 1000);
+    ESP_LOGI(TAG, "sequences=%lu edge error ns: p50=%lu p99=%lu p99.9=%lu max=%lu",
+             (unsigned long)st.sequences, (unsigned long)p50, (unsigned long)p99,
+             (unsigned long)p999, (unsigned long)max);
+    ESP_LOGI(TAG, "start latency max=%luns, late starts=%lu (budget=%luns)",
+             (unsigned long)st.start_max_ns, (unsigned long)st.late_starts,
+             (unsigned long)st.start_budget_ns);
+    ESP_LOGI(TAG, "deadline misses=%lu (lost=%lu, tolerance=%luns) -> %s",
+             (unsigned long)st.misses, (unsigned long)st.lost, (unsigned long)st.tolerance_ns,
+             st.misses == 0 ? "PASS" : "FAIL");
+
+    free(err_buf);
+    vTaskDelete(NULL);
+}
+
+void weld_jitter_start(const weld_jitter_cfg_t *cfg)
+{
+    jcfg = *cfg;
+    xTaskCreatePinnedToCore(weld_jitter_task, "weld_jitter", 4096, NULL, PRIO_UI + 1, NULL, UI_CORE);
+}
+
+bool weld_jitter_active(void)
+{
+    return jitter_active;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "weld.h"
+
+typedef struct {
+    int capture_gpio;
+    int stimulus_gpio;
+    int sequences;
+    uint32_t tolerance_ns;
+    uint32_t start_budget_ns;
+    uint32_t stimulus_period_us;
+    weld_seq_t seq;
+} weld_jitter_cfg_t;
+
+#if CONFIG_SPOT_WELD_JITTER_TEST
+
+/*
+ * Fires cfg->sequences weld sequences from a background task while the encoder
+ * pin is toggled as a stimulus, timestamps the weld output edges with an
+ * MCPWM capture channel (RMT receive at 1 us on chips without MCPWM) and logs
+ * jitter percentiles and deadline misses. The
+ * first edge is judged against weld_fire() via weld_start_latency_us(), so a
+ * late start counts as a miss, not just uneven spacing.
+ * The capture GPIO must be jumpered to the weld output, and the weld output
+ * must be disconnected from the power stage.
+ */
+void weld_jitter_start(const weld_jitter_cfg_t *cfg);
+
+/* True while the harness runs; ui_task repaints every frame meanwhile. */
+bool weld_jitter_active(void);
+
+#else
+
+static inline bool weld_jitter_active(void)
+{
+    return false;
+}
+
+#endif
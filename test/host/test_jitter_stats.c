@@ -0,0 +1,209 @@
+#include <stdio.h>
+
+#include "jitter_stats.h"
+
+/* 1 MHz capture clock keeps the arithmetic readable: one tick is 1000 ns. */
+#define TICK_HZ 1000000u
+#define TOLERANCE_NS 10000u
+#define START_BUDGET_NS 50000u
+
+static int failures;
+
+#define CHECK_EQ(actual, expected)                                                         \
+    do {                                                                                   \
+        unsigned long a_ = (unsigned long)(actual);                                        \
+        unsigned long e_ = (unsigned long)(expected);                                      \
+        if (a_ != e_) {                                                                    \
+            printf("%s:%d: %s == %lu, expected %lu\n", __FILE__, __LINE__, #actual, a_, e_); \
+            failures++;                                                                    \
+        }                                                                                  \
+    } while (0)
+
+static const uint32_t seq3[3] = {100, 200, 300};
+
+static void test_exact(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 16, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    const jitter_edge_t e[] = {{1000, true}, {1100, false}, {1300, true}, {1600, false}};
+    jitter_stats_add(&st, 0, e, 4);
+
+    CHECK_EQ(st.intervals, 3);
+    CHECK_EQ(st.sequences, 1);
+    CHECK_EQ(st.misses, 0);
+    CHECK_EQ(st.lost, 0);
+    CHECK_EQ(st.n, 3);
+    CHECK_EQ(jitter_stats_percentile(&st, 1000), 0);
+}
+
+static void test_late_edge(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 16, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    /* Second rising edge 25 us late: INTERVAL long, PULSE2 short, both over. */
+    const jitter_edge_t late[] = {{0, true}, {100, false}, {325, true}, {600, false}};
+    jitter_stats_add(&st, 0, late, 4);
+    CHECK_EQ(st.misses, 1);
+    CHECK_EQ(st.lost, 0);
+    CHECK_EQ(st.n, 3);
+    CHECK_EQ(jitter_stats_percentile(&st, 1000), 25000);
+
+    /* Exactly at tolerance is still on time. */
+    const jitter_edge_t edge[] = {{0, true}, {110, false}, {310, true}, {610, false}};
+    jitter_stats_add(&st, 0, edge, 4);
+    CHECK_EQ(st.sequences, 2);
+    CHECK_EQ(st.misses, 1);
+}
+
+static void test_missing_edge(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 16, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    const jitter_edge_t e[] = {{0, true}, {100, false}, {300, true}};
+    jitter_stats_add(&st, 0, e, 3);
+    jitter_stats_add(&st, 0, e, 0);
+
+    CHECK_EQ(st.sequences, 2);
+    CHECK_EQ(st.misses, 2);
+    CHECK_EQ(st.lost, 2);
+    CHECK_EQ(st.n, 0);
+    CHECK_EQ(jitter_stats_percentile(&st, 500), 0);
+}
+
+static void test_wrong_polarity(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 16, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    const jitter_edge_t e[] = {{0, false}, {100, true}, {300, false}, {600, true}};
+    jitter_stats_add(&st, 0, e, 4);
+
+    CHECK_EQ(st.misses, 1);
+    CHECK_EQ(st.lost, 1);
+    CHECK_EQ(st.n, 0);
+}
+
+static void test_merged_pulse(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    const jitter_edge_t single[] = {{50, true}, {450, false}};
+    const jitter_edge_t both[] = {{0, true}, {100, false}, {300, true}, {600, false}};
+
+    /* Zero INTERVAL: one pulse of PULSE1 + PULSE2. */
+    const uint32_t no_interval[3] = {100, 0, 300};
+    jitter_stats_init(&st, buf, 16, TICK_HZ, no_interval, TOLERANCE_NS, START_BUDGET_NS);
+    CHECK_EQ(st.intervals, 1);
+    CHECK_EQ(st.nominal_ns[0], 400000);
+    jitter_stats_add(&st, 0, single, 2);
+    CHECK_EQ(st.misses, 0);
+    CHECK_EQ(st.lost, 0);
+    CHECK_EQ(st.n, 1);
+
+    /* A full two-pulse capture is lost against a merged sequence. */
+    jitter_stats_add(&st, 0, both, 4);
+    CHECK_EQ(st.lost, 1);
+
+    /* Zero PULSE2: one pulse of PULSE1 alone. */
+    const uint32_t no_pulse2[3] = {400, 200, 0};
+    jitter_stats_init(&st, buf, 16, TICK_HZ, no_pulse2, TOLERANCE_NS, START_BUDGET_NS);
+    CHECK_EQ(st.intervals, 1);
+    CHECK_EQ(st.nominal_ns[0], 400000);
+    jitter_stats_add(&st, 0, single, 2);
+    CHECK_EQ(st.misses, 0);
+    CHECK_EQ(st.n, 1);
+}
+
+static void test_late_start(void)
+{
+    uint32_t buf[16];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 16, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    /* Evenly spaced edges, but the whole sequence started late. */
+    const jitter_edge_t e[] = {{0, true}, {100, false}, {300, true}, {600, false}};
+    jitter_stats_add(&st, START_BUDGET_NS + 1, e, 4);
+    CHECK_EQ(st.misses, 1);
+    CHECK_EQ(st.late_starts, 1);
+    CHECK_EQ(st.lost, 0);
+    CHECK_EQ(st.start_max_ns, START_BUDGET_NS + 1);
+    CHECK_EQ(jitter_stats_percentile(&st, 1000), 0);
+
+    /* On budget is on time; a late start with lost edges is one miss. */
+    jitter_stats_add(&st, START_BUDGET_NS, e, 4);
+    CHECK_EQ(st.misses, 1);
+    jitter_stats_add(&st, UINT32_MAX, e, 3);
+    CHECK_EQ(st.misses, 2);
+    CHECK_EQ(st.late_starts, 2);
+    CHECK_EQ(st.lost, 1);
+    CHECK_EQ(st.start_max_ns, UINT32_MAX);
+}
+
+static void test_percentiles(void)
+{
+    uint32_t buf[1000];
+    jitter_stats_t st;
+    const uint32_t single_us[3] = {1000, 0, 0};
+    jitter_stats_init(&st, buf, 1000, TICK_HZ, single_us, UINT32_MAX, UINT32_MAX);
+
+    /* Errors of 999..0 us, added in descending order so the sort matters. */
+    for (uint32_t i = 0; i < 1000; i++) {
+        const jitter_edge_t e[] = {{0, true}, {2000 - 1 - i, false}};
+        jitter_stats_add(&st, 0, e, 2);
+    }
+    CHECK_EQ(st.n, 1000);
+    CHECK_EQ(st.misses, 0);
+
+    CHECK_EQ(jitter_stats_percentile(&st, 500), 499000);
+    CHECK_EQ(jitter_stats_percentile(&st, 999), 998000);
+    CHECK_EQ(jitter_stats_percentile(&st, 1000), 999000);
+
+    /* Rounds up: with four samples the median is the second. */
+    const uint32_t four[4] = {40, 10, 30, 20};
+    for (int i = 0; i < 4; i++) {
+        buf[i] = four[i];
+    }
+    st.n = 4;
+    CHECK_EQ(jitter_stats_percentile(&st, 500), 20);
+    CHECK_EQ(jitter_stats_percentile(&st, 999), 40);
+    CHECK_EQ(jitter_stats_percentile(&st, 1000), 40);
+}
+
+static void test_capacity(void)
+{
+    uint32_t buf[2];
+    jitter_stats_t st;
+    jitter_stats_init(&st, buf, 2, TICK_HZ, seq3, TOLERANCE_NS, START_BUDGET_NS);
+
+    /* Errors past capacity are dropped but still judged against tolerance. */
+    const jitter_edge_t e[] = {{0, true}, {100, false}, {300, true}, {700, false}};
+    jitter_stats_add(&st, 0, e, 4);
+    CHECK_EQ(st.n, 2);
+    CHECK_EQ(st.misses, 1);
+}
+
+int main(void)
+{
+    test_exact();
+    test_late_edge();
+    test_missing_edge();
+    test_wrong_polarity();
+    test_merged_pulse();
+    test_late_start();
+    test_percentiles();
+    test_capacity();
+
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("jitter_stats: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Decode the spot_esp32 binary telemetry stream (see main/telemetry.h).
+
+    decode.py /dev/ttyUSB1 --baud 921600
+    decode.py capture.bin --summary
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import tty
+
+SYNC = b"\xa5\x5a"
+HEADER = struct.Struct("<BBBI")  # type, len, seq, t_us
+FRAME_OVERHEAD = 2 + HEADER.size + 2
+
+TELEM_CHARGE = 1
+TELEM_WELD = 2
+TELEM_UI = 3
+TELEM_PERF = 4
+TELEM_STATS = 5
+
+PRODUCERS = ("ui", "weld", "charge")
+PERF_NAMES = ("RENDER", "INPUT", "ENCISR", "ADDRW", "FILL", "RECT",
+              "SCREEN", "CHAR", "STRING", "PIXEL", "LINE")
+
+_PAYLOADS = {
+    TELEM_CHARGE: ("charge", struct.Struct("<HH"), ("voltage_mv", "current_ma")),
+    TELEM_WELD: ("weld", struct.Struct("<III"), ("pulse1_us", "interval_us", "pulse2_us")),
+    TELEM_UI: ("ui", struct.Struct("<BBBBHHHHHBBBBH"),
+               ("screen", "edit_mode", "main_selected", "settings_selected",
+                "pulse1_tenths", "pulse2_tenths", "interval_tenths", "auto_weld_tenths",
+                "charge_cent", "cap_charge_on", "buzzer_on", "save_mode",
+                "max_charge_power", "max_charge_current_tenths")),
+    TELEM_STATS: ("stats", struct.Struct("<" + "I" * (len(PRODUCERS) + 3)),
+                  tuple("dropped_" + p for p in PRODUCERS) + ("frames", "bytes", "tx_dropped_bytes")),
+}
+
+
+def _crc_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+_CRC_TABLE = _crc_table()
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ _CRC_TABLE[(crc >> 8) ^ b]
+    return crc
+
+
+def encode_frame(ftype, seq, t_us, payload):
+    """Builds one frame exactly as telemetry.c batch_frame() does."""
+    body = HEADER.pack(ftype, len(payload), seq & 0xFF, t_us & 0xFFFFFFFF) + payload
+    return SYNC + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def decode_payload(ftype, payload):
+    if ftype == TELEM_PERF:
+        words = struct.unpack("<%dI" % (len(payload) // 4), payload)
+        n = (len(words) - 2) // 2
+        out = {}
+        for i in range(n):
+            name = PERF_NAMES[i] if i < len(PERF_NAMES) else "id%d" % i
+            out[name] = {"count": words[2 * i], "max_us": words[2 * i + 1]}
+        out["spi_bytes"], out["spi_transactions"] = words[-2], words[-1]
+        return "perf", out
+
+    entry = _PAYLOADS.get(ftype)
+    if entry is None or len(payload) != entry[1].size:
+        return "type%d" % ftype, {"raw": payload.hex()}
+    name, fmt, fields = entry
+    return name, dict(zip(fields, fmt.unpack(payload)))
+
+
+class Decoder:
+    """Incremental frame decoder; resynchronises on the sync word after a bad CRC."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.seq_gaps = 0
+        self.skipped_bytes = 0
+        self._next_seq = None
+
+    def feed(self, data):
+        self.buf += data
+        out = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                keep = 1 if self.buf.endswith(SYNC[:1]) else 0
+                self.skipped_bytes += len(self.buf) - keep
+                del self.buf[:len(self.buf) - keep]
+                return out
+            if start:
+                self.skipped_bytes += start
+                del self.buf[:start]
+            if len(self.buf) < 2 + HEADER.size:
+                return out
+
+            ftype, length, seq, t_us = HEADER.unpack_from(self.buf, 2)
+            total = FRAME_OVERHEAD + length
+            if len(self.buf) < total:
+                return out
+
+            body = bytes(self.buf[2:total - 2])
+            (crc,) = struct.unpack_from("<H", self.buf, total - 2)
+            if crc != crc16_ccitt(body):
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+
+            del self.buf[:total]
+            if self._next_seq is not None and seq != self._next_seq:
+                self.seq_gaps += (seq - self._next_seq) & 0xFF
+            self._next_seq = (seq + 1) & 0xFF
+            self.frames += 1
+            out.append((ftype, seq, t_us, body[HEADER.size:]))
+
+
+def open_stream(path, baud):
+    if path == "-":
+        return sys.stdin.buffer.fileno()
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        if baud:
+            attrs = termios.tcgetattr(fd)
+            speed = getattr(termios, "B%d" % baud)
+            attrs[4] = attrs[5] = speed
+            termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("path", help="serial device, pty, capture file, or - for stdin")
+    ap.add_argument("--baud", type=int, default=921600, help="line rate when path is a tty")
+    ap.add_argument("--summary", action="store_true", help="only print frame and error counts at the end")
+    args = ap.parse_args()
+
+    fd = open_stream(args.path, args.baud)
+    dec = Decoder()
+    try:
+        while True:
+            data = os.read(fd, 65536)
+            if not data:
+                break
+            for ftype, seq, t_us, payload in dec.feed(data):
+                if not args.summary:
+                    name, fields = decode_payload(ftype, payload)
+                    print("%10u %3u %-6s %s" % (t_us, seq, name, fields))
+    except KeyboardInterrupt:
+        pass
+
+    print("frames=%d crc_errors=%d seq_gaps=%d skipped_bytes=%d"
+          % (dec.frames, dec.crc_errors, dec.seq_gaps, dec.skipped_bytes), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()